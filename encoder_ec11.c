@@ -12,6 +12,7 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/timers.h"
+#include "freertos/semphr.h"
 #include "esp_timer.h"
 #include "esp_log.h"
 #include "esp_err.h"
@@ -25,6 +26,13 @@ static const char *TAG = "ec11";
 #define DEBOUNCE_TICKS    2 //MAX 8
 #define SHORT_TICKS       (180 /TICKS_INTERVAL)
 #define LONG_TICKS        (1500 /TICKS_INTERVAL)
+#define LOAD_WINDOW_TICKS (1000 /TICKS_INTERVAL)
+
+#if CONFIG_EC11_SCAN_PER_CORE
+#define EC11_SCAN_GROUP_NUM  portNUM_PROCESSORS
+#else
+#define EC11_SCAN_GROUP_NUM  1
+#endif
 
 #define EC11_CHECK(a, str, ret_val)                               \
     if (!(a))                                                     \
@@ -59,152 +67,382 @@ typedef struct {
     ec11_cb_t            cb[EC11_EVENT_MAX];
 } ec11_encoder_dev_t;
 
+/**
+ * Device configurations, each one is kept in its own list and scanned by its own loop
+ */
+typedef enum {
+    EC11_VARIANT_NONE = 0,          /**< nothing to scan */
+    EC11_VARIANT_ENCODER,
+    EC11_VARIANT_BUTTON,
+    EC11_VARIANT_ENCODER_BUTTON,
+    EC11_VARIANT_MAX,
+} ec11_variant_t;
+
 typedef struct encoder_ec11 {
     ec11_encoder_dev_t *encoder;
     ec11_btn_dev_t *button;
+    uint8_t variant;         /**< ec11_variant_t, selected at create time */
+    uint8_t group;           /**< index of the scan group this device belongs to */
     struct encoder_ec11 *next;
 } ec11_dev_t;
 
-static ec11_dev_t *g_head_handle = NULL;
+typedef struct {
+    ec11_dev_t          *head[EC11_VARIANT_MAX];
+    uint16_t            dev_num;
+    SemaphoreHandle_t   lock;               /**< held while the group is scanned or its list is modified */
+    TaskHandle_t        scanner;            /**< task scanning the group, NULL when idle */
+    uint32_t            window_start_tick;
+    uint32_t            busy_acc_us;
+    uint32_t            busy_us;            /**< scan time of the last complete load window */
+    uint32_t            window_us;          /**< length of the last complete load window */
+#if CONFIG_EC11_SCAN_PER_CORE
+    TaskHandle_t        task;
+#endif
+} ec11_scan_group_t;
+
+static ec11_scan_group_t g_scan_group[EC11_SCAN_GROUP_NUM];
+static SemaphoreHandle_t g_ec11_lock = NULL;   /**< serializes create/delete and the timer state */
+static portMUX_TYPE g_ec11_init_spinlock = portMUX_INITIALIZER_UNLOCKED;
+static volatile uint32_t g_tick_cnt = 0;       /**< tick counter shared by all scan groups */
 static esp_timer_handle_t g_ec11_timer_handle;
 static bool g_is_timer_running = false;
 //uint8_t g_index = 0;
 
-static void ec11_handler(ec11_dev_t *ec11_dev)
+#if CONFIG_EC11_ENCODER_SUPPORT
+static inline void ec11_encoder_one_pos_step(ec11_dev_t *ec11_dev)
 {
-    if (NULL != ec11_dev->encoder) {
-        signal_level_t A_cur_state = gpio_get_level((uint32_t)ec11_dev->encoder->a_gpio_num);
-        signal_level_t B_cur_state = gpio_get_level((uint32_t)ec11_dev->encoder->b_gpio_num);
-        signal_level_t A_pre_state = ec11_dev->encoder->a_pre_state;
+    signal_level_t A_cur_state = gpio_get_level((uint32_t)ec11_dev->encoder->a_gpio_num);
+    signal_level_t B_cur_state = gpio_get_level((uint32_t)ec11_dev->encoder->b_gpio_num);
+    signal_level_t A_pre_state = ec11_dev->encoder->a_pre_state;
 
-        if (ONE_POSITION_ONE_PULSE == ec11_dev->encoder->type)
+    if (A_cur_state != A_pre_state)
+    {
+        if (A_cur_state == LEVEL_LOW)
         {
-            if (A_cur_state != A_pre_state)
+            if (B_cur_state == LEVEL_HIGH)
             {
-                if (A_cur_state == LEVEL_LOW)
-                {
-                    if (B_cur_state == LEVEL_HIGH)
-                    {
-                        ec11_dev->encoder->event = EC11_DIRECTION_CW;
-                        ec11_dev->encoder->pulse_cnt++;
-                        CALL_EC11_ENCODER_CB(ec11_dev, EC11_DIRECTION_CW);
-                    } else {
-                        ec11_dev->encoder->event = EC11_DIRECTION_CCW;
-                        ec11_dev->encoder->pulse_cnt--;
-                        CALL_EC11_ENCODER_CB(ec11_dev, EC11_DIRECTION_CCW);
-                    }
-                }
-                ec11_dev->encoder->a_pre_state = A_cur_state;
-                ec11_dev->encoder->b_pre_state = B_cur_state;
+                ec11_dev->encoder->event = EC11_DIRECTION_CW;
+                ec11_dev->encoder->pulse_cnt++;
+                CALL_EC11_ENCODER_CB(ec11_dev, EC11_DIRECTION_CW);
+            } else {
+                ec11_dev->encoder->event = EC11_DIRECTION_CCW;
+                ec11_dev->encoder->pulse_cnt--;
+                CALL_EC11_ENCODER_CB(ec11_dev, EC11_DIRECTION_CCW);
             }
         }
-    } else { /*TWO_POSITION_ONE_PULSE*/
-        // TODO
+        ec11_dev->encoder->a_pre_state = A_cur_state;
+        ec11_dev->encoder->b_pre_state = B_cur_state;
     }
+}
+#endif /* CONFIG_EC11_ENCODER_SUPPORT */
 
-    /*button handle*/
-    if (NULL != ec11_dev->button)
-    {
-        uint8_t read_bnt_level = gpio_get_level((uint32_t)ec11_dev->button->gpio_num);
+#if CONFIG_EC11_BUTTON_SUPPORT
+static inline void ec11_button_step(ec11_dev_t *ec11_dev)
+{
+    uint8_t read_bnt_level = gpio_get_level((uint32_t)ec11_dev->button->gpio_num);
 
-        /** ticks counter working.. */
-        if (ec11_dev->button->state > 0) {
-            ec11_dev->button->ticks++;
-        }
+    /** ticks counter working.. */
+    if (ec11_dev->button->state > 0) {
+        ec11_dev->button->ticks++;
+    }
 
-        /**< button debounce handle */
-        if (read_bnt_level != ec11_dev->button->level) {
-            if(++(ec11_dev->button->debounce_cnt) >= DEBOUNCE_TICKS) {
-                ec11_dev->button->level = read_bnt_level;
-                ec11_dev->button->debounce_cnt = 0;
-            }
-                       
-        } else {
+    /**< button debounce handle */
+    if (read_bnt_level != ec11_dev->button->level) {
+        if(++(ec11_dev->button->debounce_cnt) >= DEBOUNCE_TICKS) {
+            ec11_dev->button->level = read_bnt_level;
             ec11_dev->button->debounce_cnt = 0;
         }
-        //ESP_LOGE(CB, "ec11_dev->button->level : %d", ec11_dev->button->level);
-        /** State machine */
-        switch (ec11_dev->button->state) {
-            case 0:
-                if (ec11_dev->button->level == ec11_dev->button->active_level) {
-                    ec11_dev->button->event = EC11_BNT_PRESS_DOWN;
-                    CALL_EC11_BUTTON_CB(ec11_dev, EC11_BNT_PRESS_DOWN); //event callback
-                    ec11_dev->button->ticks = 0;
-                    ec11_dev->button->repeat = 1;
-                    ec11_dev->button->state = 1;
-                } else {
-                   ec11_dev->button->event = EC11_BNT_NONE_PRESS; 
+
+    } else {
+        ec11_dev->button->debounce_cnt = 0;
+    }
+    //ESP_LOGE(CB, "ec11_dev->button->level : %d", ec11_dev->button->level);
+    /** State machine */
+    switch (ec11_dev->button->state) {
+        case 0:
+            if (ec11_dev->button->level == ec11_dev->button->active_level) {
+                ec11_dev->button->event = EC11_BNT_PRESS_DOWN;
+                CALL_EC11_BUTTON_CB(ec11_dev, EC11_BNT_PRESS_DOWN); //event callback
+                ec11_dev->button->ticks = 0;
+                ec11_dev->button->repeat = 1;
+                ec11_dev->button->state = 1;
+            } else {
+               ec11_dev->button->event = EC11_BNT_NONE_PRESS;
+            }
+        break;
+
+        case 1:
+            if (ec11_dev->button->level != ec11_dev->button->active_level) {
+                ec11_dev->button->event = EC11_BNT_PRESS_UP;
+                CALL_EC11_BUTTON_CB(ec11_dev, EC11_BNT_PRESS_UP); //event callback
+                ec11_dev->button->ticks = 0;
+                ec11_dev->button->state = 2;
+            } else if (ec11_dev->button->ticks > LONG_TICKS) {
+                ec11_dev->button->event = EC11_BNT_LONG_PRESS_START;
+                CALL_EC11_BUTTON_CB(ec11_dev, EC11_BNT_LONG_PRESS_START); //event callback
+                ec11_dev->button->state = 4;
+            }
+        break;
+
+        case 2:
+            if (ec11_dev->button->level == ec11_dev->button->active_level) {
+                ec11_dev->button->event = EC11_BNT_PRESS_DOWN;
+                ec11_dev->button->repeat++;
+                CALL_EC11_BUTTON_CB(ec11_dev, EC11_BNT_PRESS_REPEAT); //event callback
+                CALL_EC11_BUTTON_CB(ec11_dev, EC11_BNT_PRESS_DOWN); //event callback
+                ec11_dev->button->ticks = 0;
+                ec11_dev->button->state = 3;
+            } else if (ec11_dev->button->ticks > SHORT_TICKS) {
+                if (ec11_dev->button->repeat == 1) {
+                    ec11_dev->button->event = EC11_BNT_SINGLE_CLICK;
+                    CALL_EC11_BUTTON_CB(ec11_dev, EC11_BNT_SINGLE_CLICK); //event callback
+                } else if (ec11_dev->button->repeat == 2) {
+                    ec11_dev->button->event = EC11_BNT_DOUBLE_CLICK;
+                    CALL_EC11_BUTTON_CB(ec11_dev, EC11_BNT_DOUBLE_CLICK); //event callback
                 }
-            break;
+                ec11_dev->button->state = 0;
+            }
+        break;
 
-            case 1:
-                if (ec11_dev->button->level != ec11_dev->button->active_level) {
-                    ec11_dev->button->event = EC11_BNT_PRESS_UP;
-                    CALL_EC11_BUTTON_CB(ec11_dev, EC11_BNT_PRESS_UP); //event callback
+        case 3:
+            if (ec11_dev->button->level != ec11_dev->button->active_level) {
+                ec11_dev->button->event = EC11_BNT_PRESS_UP;
+                CALL_EC11_BUTTON_CB(ec11_dev, EC11_BNT_PRESS_UP); //event callback
+                if (ec11_dev->button->ticks < SHORT_TICKS) {
                     ec11_dev->button->ticks = 0;
                     ec11_dev->button->state = 2;
-                } else if (ec11_dev->button->ticks > LONG_TICKS) {
-                    ec11_dev->button->event = EC11_BNT_LONG_PRESS_START;
-                    CALL_EC11_BUTTON_CB(ec11_dev, EC11_BNT_LONG_PRESS_START); //event callback
-                    ec11_dev->button->state = 4;
-                }
-            break;
-
-            case 2:
-                if (ec11_dev->button->level == ec11_dev->button->active_level) {
-                    ec11_dev->button->event = EC11_BNT_PRESS_DOWN;
-                    ec11_dev->button->repeat++;
-                    CALL_EC11_BUTTON_CB(ec11_dev, EC11_BNT_PRESS_REPEAT); //event callback
-                    CALL_EC11_BUTTON_CB(ec11_dev, EC11_BNT_PRESS_DOWN); //event callback
-                    ec11_dev->button->ticks = 0;
-                    ec11_dev->button->state = 3;
-                } else if (ec11_dev->button->ticks > SHORT_TICKS) {
-                    if (ec11_dev->button->repeat == 1) {
-                        ec11_dev->button->event = EC11_BNT_SINGLE_CLICK;
-                        CALL_EC11_BUTTON_CB(ec11_dev, EC11_BNT_SINGLE_CLICK); //event callback
-                    } else if (ec11_dev->button->repeat == 2) {
-                        ec11_dev->button->event = EC11_BNT_DOUBLE_CLICK;
-                        CALL_EC11_BUTTON_CB(ec11_dev, EC11_BNT_DOUBLE_CLICK); //event callback
-                    }
-                    ec11_dev->button->state = 0;
-                }
-            break;
-
-            case 3:
-                if (ec11_dev->button->level != ec11_dev->button->active_level) {
-                    ec11_dev->button->event = EC11_BNT_PRESS_UP;
-                    CALL_EC11_BUTTON_CB(ec11_dev, EC11_BNT_PRESS_UP); //event callback
-                    if (ec11_dev->button->ticks < SHORT_TICKS) {
-                        ec11_dev->button->ticks = 0;
-                        ec11_dev->button->state = 2;
-                    } else {
-                        ec11_dev->button->state = 0;
-                    }
-                }
-            break;
-
-            case 4:
-                if (ec11_dev->button->level == ec11_dev->button->active_level) {
-                    ec11_dev->button->event = EC11_BNT_LONG_PRESS_HOLD;
-                    CALL_EC11_BUTTON_CB(ec11_dev, EC11_BNT_LONG_PRESS_HOLD); //event callback
                 } else {
-                    ec11_dev->button->event = EC11_BNT_PRESS_UP;
-                    CALL_EC11_BUTTON_CB(ec11_dev, EC11_BNT_PRESS_UP); //event callback
                     ec11_dev->button->state = 0;
                 }
-            break;
+            }
+        break;
+
+        case 4:
+            if (ec11_dev->button->level == ec11_dev->button->active_level) {
+                ec11_dev->button->event = EC11_BNT_LONG_PRESS_HOLD;
+                CALL_EC11_BUTTON_CB(ec11_dev, EC11_BNT_LONG_PRESS_HOLD); //event callback
+            } else {
+                ec11_dev->button->event = EC11_BNT_PRESS_UP;
+                CALL_EC11_BUTTON_CB(ec11_dev, EC11_BNT_PRESS_UP); //event callback
+                ec11_dev->button->state = 0;
+            }
+        break;
+
+        default : break;
+    }
+}
+#endif /* CONFIG_EC11_BUTTON_SUPPORT */
+
+#define EC11_NO_STEP(dev) ((void)(dev))
+
+/**
+ * Generate the scan loop of one device list. Every device in the list has the
+ * same configuration, so the steps are called directly without NULL or type checks.
+ */
+#define EC11_DEFINE_SCAN(name, encoder_step, button_step)                      \
+    static void name(ec11_dev_t *head)                                          \
+    {                                                                           \
+        for (ec11_dev_t *ec11_dev = head; ec11_dev; ec11_dev = ec11_dev->next) { \
+            encoder_step(ec11_dev);                                             \
+            button_step(ec11_dev);                                              \
+        }                                                                       \
+    }
 
-            default : break;
+#if CONFIG_EC11_ENCODER_SUPPORT
+EC11_DEFINE_SCAN(ec11_scan_encoder, ec11_encoder_one_pos_step, EC11_NO_STEP)
+#endif
+#if CONFIG_EC11_BUTTON_SUPPORT
+EC11_DEFINE_SCAN(ec11_scan_button, EC11_NO_STEP, ec11_button_step)
+#endif
+#if CONFIG_EC11_ENCODER_SUPPORT && CONFIG_EC11_BUTTON_SUPPORT
+EC11_DEFINE_SCAN(ec11_scan_encoder_button, ec11_encoder_one_pos_step, ec11_button_step)
+#endif
+
+static ec11_variant_t ec11_select_variant(const ec11_dev_t *ec11)
+{
+    /*TWO_POSITION_ONE_PULSE*/
+    // TODO: no decoder yet, such encoders are not scanned
+    bool decode = (NULL != ec11->encoder) && (ONE_POSITION_ONE_PULSE == ec11->encoder->type);
+    (void)decode;
+
+#if CONFIG_EC11_ENCODER_SUPPORT && CONFIG_EC11_BUTTON_SUPPORT
+    if (decode && NULL != ec11->button) {
+        return EC11_VARIANT_ENCODER_BUTTON;
+    }
+#endif
+#if CONFIG_EC11_ENCODER_SUPPORT
+    if (decode) {
+        return EC11_VARIANT_ENCODER;
+    }
+#endif
+#if CONFIG_EC11_BUTTON_SUPPORT
+    if (NULL != ec11->button) {
+        return EC11_VARIANT_BUTTON;
+    }
+#endif
+    return EC11_VARIANT_NONE;
+}
+
+static void ec11_scan_group(ec11_scan_group_t *group)
+{
+    uint32_t tick = g_tick_cnt;
+
+    xSemaphoreTake(group->lock, portMAX_DELAY);
+    group->scanner = xTaskGetCurrentTaskHandle();
+    int64_t start = esp_timer_get_time();
+#if CONFIG_EC11_ENCODER_SUPPORT
+    ec11_scan_encoder(group->head[EC11_VARIANT_ENCODER]);
+#endif
+#if CONFIG_EC11_BUTTON_SUPPORT
+    ec11_scan_button(group->head[EC11_VARIANT_BUTTON]);
+#endif
+#if CONFIG_EC11_ENCODER_SUPPORT && CONFIG_EC11_BUTTON_SUPPORT
+    ec11_scan_encoder_button(group->head[EC11_VARIANT_ENCODER_BUTTON]);
+#endif
+    group->busy_acc_us += (uint32_t)(esp_timer_get_time() - start);
+
+    /** load window is counted in shared ticks so all groups report the same period */
+    if ((uint32_t)(tick - group->window_start_tick) >= LOAD_WINDOW_TICKS) {
+        group->busy_us = group->busy_acc_us;
+        group->window_us = (tick - group->window_start_tick) * TICKS_INTERVAL * 1000U;
+        group->busy_acc_us = 0;
+        group->window_start_tick = tick;
+    }
+    group->scanner = NULL;
+    xSemaphoreGive(group->lock);
+}
+
+/**
+ * EC11 callbacks run with the group lock held, so APIs taking the EC11 locks
+ * would deadlock when called from them.
+ */
+static bool ec11_is_in_callback(void)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (int i = 0; i < EC11_SCAN_GROUP_NUM; i++) {
+        if (self == g_scan_group[i].scanner) {
+            return true;
         }
     }
+    return false;
 }
 
+#if CONFIG_EC11_SCAN_PER_CORE
+static void ec11_scan_task(void *args)
+{
+    ec11_scan_group_t *group = (ec11_scan_group_t *)args;
+    while (1) {
+        /** one scan per timer tick, a late task catches up so button timing matches the other cores */
+        ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+        ec11_scan_group(group);
+    }
+}
+#endif
+
 static void ec11_cb(void *args)
 {
-    ec11_dev_t *target;
-    for (target = g_head_handle; target; target = target->next) {
-        ec11_handler(target);
+    g_tick_cnt++;
+#if CONFIG_EC11_SCAN_PER_CORE
+    for (int i = 0; i < EC11_SCAN_GROUP_NUM; i++) {
+        if (NULL != g_scan_group[i].task) {
+            xTaskNotifyGive(g_scan_group[i].task);
+        }
+    }
+#else
+    ec11_scan_group(&g_scan_group[0]);
+#endif
+}
+
+static void ec11_lock_free(SemaphoreHandle_t lock, SemaphoreHandle_t *group_lock)
+{
+    if (NULL != lock) {
+        vSemaphoreDelete(lock);
+    }
+    for (int i = 0; i < EC11_SCAN_GROUP_NUM; i++) {
+        if (NULL != group_lock[i]) {
+            vSemaphoreDelete(group_lock[i]);
+        }
+    }
+}
+
+static esp_err_t ec11_lock_init(void)
+{
+    bool is_ready;
+    portENTER_CRITICAL(&g_ec11_init_spinlock);
+    is_ready = (NULL != g_ec11_lock);
+    portEXIT_CRITICAL(&g_ec11_init_spinlock);
+    if (is_ready) {
+        return ESP_OK;
     }
+
+    /** FreeRTOS APIs must not be called inside the critical section, create first and publish after */
+    SemaphoreHandle_t lock = xSemaphoreCreateMutex();
+    SemaphoreHandle_t group_lock[EC11_SCAN_GROUP_NUM];
+    bool is_created = (NULL != lock);
+    for (int i = 0; i < EC11_SCAN_GROUP_NUM; i++) {
+        group_lock[i] = xSemaphoreCreateMutex();
+        is_created = is_created && (NULL != group_lock[i]);
+    }
+    if (!is_created) {
+        ec11_lock_free(lock, group_lock);
+        ESP_LOGE(TAG, "ec11 lock create failed");
+        return ESP_ERR_NO_MEM;
+    }
+
+    portENTER_CRITICAL(&g_ec11_init_spinlock);
+    is_ready = (NULL != g_ec11_lock);
+    if (!is_ready) {
+        for (int i = 0; i < EC11_SCAN_GROUP_NUM; i++) {
+            g_scan_group[i].lock = group_lock[i];
+        }
+        g_ec11_lock = lock;
+    }
+    portEXIT_CRITICAL(&g_ec11_init_spinlock);
+
+    if (is_ready) { /**< another task won the race, drop ours */
+        ec11_lock_free(lock, group_lock);
+    }
+    return ESP_OK;
+}
+
+static esp_err_t ec11_timer_start(void)
+{
+#if CONFIG_EC11_SCAN_PER_CORE
+    /** scan tasks are kept once created, a late notify from the timer must never hit a deleted task */
+    for (int i = 0; i < EC11_SCAN_GROUP_NUM; i++) {
+        if (NULL == g_scan_group[i].task) {
+            BaseType_t ret = xTaskCreatePinnedToCore(ec11_scan_task, "ec11_scan", CONFIG_EC11_SCAN_TASK_STACK_SIZE,
+                                                     &g_scan_group[i], CONFIG_EC11_SCAN_TASK_PRIORITY,
+                                                     &g_scan_group[i].task, i);
+            EC11_CHECK(pdPASS == ret, "ec11 scan task create failed", ESP_ERR_NO_MEM);
+        }
+    }
+#endif
+
+    /** drop the load of a previous run, window_us stays 0 until the first window completes */
+    for (int i = 0; i < EC11_SCAN_GROUP_NUM; i++) {
+        xSemaphoreTake(g_scan_group[i].lock, portMAX_DELAY);
+        g_scan_group[i].window_start_tick = g_tick_cnt;
+        g_scan_group[i].busy_acc_us = 0;
+        g_scan_group[i].busy_us = 0;
+        g_scan_group[i].window_us = 0;
+        xSemaphoreGive(g_scan_group[i].lock);
+    }
+
+    esp_timer_create_args_t ec11_timer;
+    ec11_timer.arg = NULL;
+    ec11_timer.callback = ec11_cb;
+    ec11_timer.dispatch_method = ESP_TIMER_TASK;
+    ec11_timer.name = "ec11_timer";
+    EC11_CHECK(ESP_OK == esp_timer_create(&ec11_timer, &g_ec11_timer_handle), "ec11 timer create failed", ESP_FAIL);
+    if (ESP_OK != esp_timer_start_periodic(g_ec11_timer_handle, TICKS_INTERVAL * 1000U)) {
+        esp_timer_delete(g_ec11_timer_handle);
+        ESP_LOGE(TAG, "ec11 timer start failed");
+        return ESP_FAIL;
+    }
+    g_is_timer_running = true;
+
+    return ESP_OK;
 }
 
 esp_err_t ec11_gpio_init(const ec11_config_t *cfg)
@@ -214,17 +452,19 @@ esp_err_t ec11_gpio_init(const ec11_config_t *cfg)
     gpio_conf.mode = GPIO_MODE_INPUT;
     gpio_conf.pull_down_en = GPIO_PULLDOWN_DISABLE;
     gpio_conf.pull_up_en = GPIO_PULLUP_ENABLE;
-    if (-1 == cfg->button_gpio_num) {
-        gpio_conf.pin_bit_mask = ((1ULL << cfg->signal_A_gpio_num) |
-                                  (1ULL << cfg->signal_B_gpio_num));
+    gpio_conf.pin_bit_mask = 0;
+    /** only pins in use, shifting by a -1 pin number is undefined */
+    if ((-1 != cfg->signal_A_gpio_num) && (-1 != cfg->signal_B_gpio_num)) {
+        gpio_conf.pin_bit_mask |= ((1ULL << cfg->signal_A_gpio_num) |
+                                   (1ULL << cfg->signal_B_gpio_num));
     }
-    else {
-        gpio_conf.pin_bit_mask = ((1ULL << cfg->signal_A_gpio_num) |
-                                  (1ULL << cfg->signal_B_gpio_num) |
-                                  (1ULL << cfg->button_gpio_num));
+    if (-1 != cfg->button_gpio_num) {
+        gpio_conf.pin_bit_mask |= (1ULL << cfg->button_gpio_num);
     }
 
-    gpio_config(&gpio_conf);
+    if (0 != gpio_conf.pin_bit_mask) {
+        gpio_config(&gpio_conf);
+    }
 
     return ESP_OK;
 }
@@ -263,8 +503,50 @@ esp_err_t ec11_dev_init(ec11_dev_t *ec11)
     return ESP_OK;
 }
 
+static void ec11_group_unlink(ec11_scan_group_t *group, ec11_dev_t *ec11)
+{
+    /** unlink under the group lock so a running scan never sees a freed device */
+    xSemaphoreTake(group->lock, portMAX_DELAY);
+    ec11_dev_t ** curr;
+    for (curr = &group->head[ec11->variant]; *curr; ) {
+        ec11_dev_t * entry = *curr;
+        if (entry == ec11) {
+            *curr = entry->next;
+            group->dev_num--;
+        } else {
+            curr = &entry->next;
+        }
+    }
+    xSemaphoreGive(group->lock);
+}
+
+static void ec11_dev_free(ec11_dev_t *ec11)
+{
+    if(NULL != ec11->encoder) {
+        ec11_gpio_deinit(ec11->encoder->a_gpio_num);
+        ec11_gpio_deinit(ec11->encoder->b_gpio_num);
+        free(ec11->encoder);
+    }
+
+    if(NULL != ec11->button) {
+        ec11_gpio_deinit(ec11->button->gpio_num);
+        free(ec11->button);
+    }
+    free(ec11);
+}
+
 encoder_ec11_handle_t encoder_ec11_create(const ec11_config_t *config)
 {
+#if !CONFIG_EC11_ENCODER_SUPPORT
+    EC11_CHECK((-1 == config->signal_A_gpio_num) || (-1 == config->signal_B_gpio_num),
+               "encoder support is disabled (CONFIG_EC11_ENCODER_SUPPORT)", NULL);
+#endif
+#if !CONFIG_EC11_BUTTON_SUPPORT
+    EC11_CHECK(-1 == config->button_gpio_num, "button support is disabled (CONFIG_EC11_BUTTON_SUPPORT)", NULL);
+#endif
+    EC11_CHECK(!ec11_is_in_callback(), "can not be called from an EC11 callback", NULL);
+    EC11_CHECK(ESP_OK == ec11_lock_init(), "ec11 lock init failed", NULL);
+
     ec11_dev_t *ec11 = (ec11_dev_t *)calloc(1, sizeof(ec11_dev_t));
     EC11_CHECK(NULL != ec11, "ec11 memory alloc failed", NULL);
 
@@ -303,25 +585,39 @@ encoder_ec11_handle_t encoder_ec11_create(const ec11_config_t *config)
         ec11->button->level = !ec11->button->active_level;
     }
 
+    ec11->variant = ec11_select_variant(ec11);
+
     ec11_gpio_init(config);
 
-    /** Add handle to list */
-    ec11->next = g_head_handle;
-    g_head_handle = ec11;
+    xSemaphoreTake(g_ec11_lock, portMAX_DELAY);
+
+    /** Add handle to the scan group with the fewest devices */
+    uint8_t index = 0;
+    for (uint8_t i = 1; i < EC11_SCAN_GROUP_NUM; i++) {
+        if (g_scan_group[i].dev_num < g_scan_group[index].dev_num) {
+            index = i;
+        }
+    }
+    ec11_scan_group_t *group = &g_scan_group[index];
+    ec11->group = index;
+
+    xSemaphoreTake(group->lock, portMAX_DELAY);
+    ec11->next = group->head[ec11->variant];
+    group->head[ec11->variant] = ec11;
+    group->dev_num++;
+    xSemaphoreGive(group->lock);
 
     /*set ec11 timer*/
-    if (false == g_is_timer_running)
+    if ((false == g_is_timer_running) && (ESP_OK != ec11_timer_start()))
     {
-        esp_timer_create_args_t ec11_timer;
-        ec11_timer.arg = NULL;
-        ec11_timer.callback = ec11_cb;
-        ec11_timer.dispatch_method = ESP_TIMER_TASK;
-        ec11_timer.name = "ec11_timer";
-        esp_timer_create(&ec11_timer, &g_ec11_timer_handle);
-        esp_timer_start_periodic(g_ec11_timer_handle, TICKS_INTERVAL * 1000U);
-        g_is_timer_running = true;
+        ec11_group_unlink(group, ec11);
+        xSemaphoreGive(g_ec11_lock);
+        ec11_dev_free(ec11);
+        return NULL;
     }
 
+    xSemaphoreGive(g_ec11_lock);
+
     return (encoder_ec11_handle_t)ec11;
 }
 
@@ -329,36 +625,19 @@ esp_err_t encoder_ec11_delete(encoder_ec11_handle_t ec11_handle)
 {
     esp_err_t ret = ESP_OK;
     EC11_CHECK(NULL != ec11_handle, "Pointer of handle is invalid", ESP_ERR_INVALID_ARG);
+    EC11_CHECK(!ec11_is_in_callback(), "can not be called from an EC11 callback", ESP_ERR_INVALID_STATE);
     ec11_dev_t * ec11 = (ec11_dev_t * ) ec11_handle;
+    ec11_scan_group_t *group = &g_scan_group[ec11->group];
 
-    if(NULL != ec11->encoder) {
-        ec11_gpio_deinit(ec11->encoder->a_gpio_num);
-        ec11_gpio_deinit(ec11->encoder->b_gpio_num);
-        free(ec11->encoder);
-    }
+    xSemaphoreTake(g_ec11_lock, portMAX_DELAY);
 
-    if(NULL != ec11->button) {
-        ec11_gpio_deinit(ec11->button->gpio_num);
-        free(ec11->button);
-    }
-
-    ec11_dev_t ** curr;
-    for (curr = &g_head_handle; *curr; ) {
-        ec11_dev_t * entry = *curr;
-        if (entry == ec11) {
-            *curr = entry->next;
-            free(entry);
-        } else {
-            curr = &entry->next;
-        }
-    }
+    ec11_group_unlink(group, ec11);
+    ec11_dev_free(ec11);
 
     /* count ec11 number */
     uint16_t number = 0;
-    ec11_dev_t * target = g_head_handle;
-    while (target) {
-        target = target->next;
-        number++;
+    for (int i = 0; i < EC11_SCAN_GROUP_NUM; i++) {
+        number += g_scan_group[i].dev_num;
     }
     ESP_LOGD(TAG, "remain ec11 number=%d", number);
 
@@ -368,9 +647,33 @@ esp_err_t encoder_ec11_delete(encoder_ec11_handle_t ec11_handle)
         g_is_timer_running = false;
     }
 
+    xSemaphoreGive(g_ec11_lock);
+
     return ret;
 }
 
+uint8_t encoder_ec11_get_scan_group_num(void)
+{
+    return EC11_SCAN_GROUP_NUM;
+}
+
+esp_err_t encoder_ec11_get_scan_load(uint8_t group, ec11_scan_load_t *load)
+{
+    EC11_CHECK(group < EC11_SCAN_GROUP_NUM, "scan group is invalid", ESP_ERR_INVALID_ARG);
+    EC11_CHECK(NULL != load, "Pointer of load is invalid", ESP_ERR_INVALID_ARG);
+    EC11_CHECK(!ec11_is_in_callback(), "can not be called from an EC11 callback", ESP_ERR_INVALID_STATE);
+
+    EC11_CHECK(ESP_OK == ec11_lock_init(), "ec11 lock init failed", ESP_ERR_NO_MEM);
+    ec11_scan_group_t *scan_group = &g_scan_group[group];
+    xSemaphoreTake(scan_group->lock, portMAX_DELAY);
+    load->device_num = scan_group->dev_num;
+    load->busy_us = scan_group->busy_us;
+    load->window_us = scan_group->window_us;
+    xSemaphoreGive(scan_group->lock);
+
+    return ESP_OK;
+}
+
 ec11_bnt_event_t ec11_button_get_event(encoder_ec11_handle_t ec11_handle)
 {
     ec11_bnt_event_t event;
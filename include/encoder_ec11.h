@@ -66,6 +66,16 @@ typedef struct {
     uint32_t        button_gpio_num;
 }ec11_config_t;
 
+/**
+ * @brief Scan load of one scan group
+ *
+ */
+typedef struct {
+    uint16_t device_num;  /**< Number of EC11 handles scanned by this group */
+    uint32_t busy_us;     /**< Time spent scanning during the last load window */
+    uint32_t window_us;   /**< Length of the last load window, 0 until the first window completes after the scan (re)starts */
+} ec11_scan_load_t;
+
 /**
  * @brief Short name of EC11 handle
  *
@@ -79,6 +89,8 @@ typedef encoder_ec11_handle_t ec11_handle_t;
  *               if signal_A_gpio_num or signal_B_gpio_num is set to -1 means do not use the encoder.
  *               if button_gpio_num is set to -1 means do not use the button.
  *
+ * @note Must not be called from inside an EC11 callback, it fails with NULL.
+ *
  * @return A handle to the created EC11, or NULL in case of error.
  */
 encoder_ec11_handle_t encoder_ec11_create(const ec11_config_t * config);
@@ -88,12 +100,39 @@ encoder_ec11_handle_t encoder_ec11_create(const ec11_config_t * config);
  *
  * @param ec11_handle A EC11 handle to delete
  *
+ * @note Safe to call while the scan is running, but not from inside an EC11 callback.
+ *
  * @return
  *      - ESP_OK  Success
  *      - ESP_FAIL Failure
+ *      - ESP_ERR_INVALID_STATE Called from an EC11 callback.
  */
 esp_err_t encoder_ec11_delete(encoder_ec11_handle_t ec11_handle);
 
+/**
+ * @brief Get the number of scan groups
+ *
+ * @return portNUM_PROCESSORS with CONFIG_EC11_SCAN_PER_CORE, otherwise 1.
+ */
+uint8_t encoder_ec11_get_scan_group_num(void);
+
+/**
+ * @brief Get the scan load of a scan group
+ *
+ * @param group Scan group index, 0 .. encoder_ec11_get_scan_group_num() - 1.
+ *              With CONFIG_EC11_SCAN_PER_CORE it is the core id the group runs on,
+ *              otherwise only group 0 exists and it runs in the esp_timer task.
+ * @param load Pointer to store the load of the last load window (about 1 second).
+ *
+ * @note Must not be called from inside an EC11 callback.
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG   Arguments is invalid.
+ *      - ESP_ERR_INVALID_STATE Called from an EC11 callback.
+ */
+esp_err_t encoder_ec11_get_scan_load(uint8_t group, ec11_scan_load_t *load);
+
 /**
  * @brief Register event callback function of EC11 button.
  *